@@ -121,10 +121,7 @@ int main() {
                 det.generate(rm.begin() + s * SimConfig::TxAntNum * SimConfig::QAM::bitLength);
 
                 auto mmse = MMSE<SimConfig::QAM, float, SimConfig::TxAntNum, SimConfig::RxAntNum>(det.H, det.RxSymbols, static_cast<float>(det.Nv));
-                mmse.compute_llr();
-
-                std::copy(mmse.llr.data(), mmse.llr.data() + mmse.llr.size(),
-                          LLR_all.data() + s * SimConfig::TxAntNum * SimConfig::QAM::bitLength);
+                mmse.compute_llr(std::span(LLR_all), s * SimConfig::TxAntNum * SimConfig::QAM::bitLength);
             }
 
             // 3. LDPC 速率恢复与译码
@@ -9,6 +9,8 @@
 #include <sstream>
 #include <string>
 #include <functional>
+#include <algorithm>
+#include <span>
 
 using Kito::QAM16;
 using Kito::QAM64;
@@ -17,7 +19,7 @@ using Kito::QAM256;
 // ===================== 仿真参数配置 =====================
 static constexpr size_t TxAntNum = 32;
 static constexpr size_t RxAntNum = 32;
-static constexpr size_t K_BEST_K = 16;     // K-Best 的 K 值
+static constexpr size_t K_BEST_K = 16;     // K-Best 的 K 值（自适应 K-Best 的上限）
 static constexpr size_t EP_ITER  = 10;     // EP 迭代次数
 
 using QAM = QAM64<float>;
@@ -37,6 +39,21 @@ struct ThreadResult {
     long long err_bits    = 0;
     long long err_symbols = 0;
     long long processed   = 0;
+    long long searches    = 0;   // 提供 averageK 的检测器：树搜索次数与各层保留路径数之和
+    long long kept_paths  = 0;
+    Kito::NodeHistogram nodes;   // 提供 nodeStats 的检测器（球形译码）：每帧访问节点数的分布
+};
+
+// 跨线程合并的节点数分布
+struct SharedNodeStats {
+    std::mutex          mutex;
+    Kito::NodeHistogram hist;
+
+    void merge(const Kito::NodeHistogram& local) {
+        if (local.frames == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        hist.merge(local);
+    }
 };
 
 // ===================== 单个 SNR 点的结果 =====================
@@ -46,6 +63,29 @@ struct SnrResult {
     double ser        = 0;
     double fer        = 0;
     long long samples = 0;
+    double avg_k      = 0;   // 每层平均保留的路径数，检测器不提供时为 0
+    Kito::NodeHistogram nodes;   // 每帧访问节点数的分布，检测器不提供时为空
+};
+
+// ===================== 多 SNR 单遍评估的计数器 =====================
+// 每个样本 (H, x, 单位噪声) 在所有 SNR 点上评估，各 SNR 点的计数并列累加
+struct MultiSnrCounters {
+    std::vector<std::atomic<long long>> progress;
+    std::vector<std::atomic<long long>> err_frames;
+    std::vector<std::atomic<long long>> err_bits;
+    std::vector<std::atomic<long long>> err_symbols;
+    std::vector<std::atomic<long long>> searches;
+    std::vector<std::atomic<long long>> kept_paths;
+    std::vector<SharedNodeStats>        nodes;
+
+    explicit MultiSnrCounters(size_t n)
+        : progress(n), err_frames(n), err_bits(n), err_symbols(n), searches(n), kept_paths(n), nodes(n) {}
+
+    // 达到错误帧门限或样本上限的 SNR 点不再评估
+    bool active(size_t i, long long max_sample, long long err_frame_threshold) const {
+        return err_frames[i].load(std::memory_order_relaxed) < err_frame_threshold &&
+               progress[i].load(std::memory_order_relaxed) < max_sample;
+    }
 };
 
 // ===================== 算法描述 =====================
@@ -57,13 +97,41 @@ struct AlgorithmEntry {
         std::atomic<long long>& global_err_frames,
         std::atomic<long long>& global_err_bits,
         std::atomic<long long>& global_err_symbols,
+        std::atomic<long long>& global_searches,
+        std::atomic<long long>& global_kept_paths,
+        SharedNodeStats&        global_nodes,
         std::atomic<bool>&      should_stop,
         long long max_sample,
         long long err_frame_threshold
     )>;
     WorkerFactory factory;
+
+    using MultiWorkerFactory = std::function<std::function<void(unsigned int)>(
+        const std::vector<int>& snrs,
+        MultiSnrCounters&       counters,
+        std::atomic<bool>&      should_stop,
+        long long max_sample,
+        long long err_frame_threshold
+    )>;
+    MultiWorkerFactory multi_factory;
 };
 
+static double rate(long long errors, long long total, size_t per_sample) {
+    return (total > 0) ? static_cast<double>(errors) / (static_cast<double>(total) * per_sample) : 0.0;
+}
+
+// 每层平均保留的路径数
+static double average_k(long long kept_paths, long long searches) {
+    return rate(kept_paths, searches, 2 * TxAntNum);
+}
+
+// 每帧访问节点数：均值 / p99 / 最大值
+static void print_nodes(const Kito::NodeHistogram& nodes) {
+    if (nodes.frames == 0) return;
+    std::cout << "  nodes(mean/p99/max)=" << std::fixed << std::setprecision(1) << nodes.mean()
+              << "/" << nodes.quantile(0.99) << "/" << nodes.max;
+}
+
 // ===================== 通用 SNR 扫描框架 =====================
 std::vector<SnrResult> run_sweep(
     const std::string& algo_name,
@@ -79,6 +147,9 @@ std::vector<SnrResult> run_sweep(
         std::atomic<long long> global_err_frames(0);
         std::atomic<long long> global_err_bits(0);
         std::atomic<long long> global_err_symbols(0);
+        std::atomic<long long> global_searches(0);
+        std::atomic<long long> global_kept_paths(0);
+        SharedNodeStats        global_nodes;
         std::atomic<bool>      should_stop(false);
         std::atomic<size_t>    last_progress_len(0);
 
@@ -87,6 +158,7 @@ std::vector<SnrResult> run_sweep(
         auto worker = factory(snr,
                               global_progress, global_err_frames,
                               global_err_bits, global_err_symbols,
+                              global_searches, global_kept_paths, global_nodes,
                               should_stop, max_sample, err_frame_threshold);
 
         auto start = std::chrono::high_resolution_clock::now();
@@ -142,8 +214,9 @@ std::vector<SnrResult> run_sweep(
         double ber = (progress > 0) ? static_cast<double>(eb) / (progress * TxAntNum * QAM::bitLength) : 0.0;
         double ser = (progress > 0) ? static_cast<double>(es) / (progress * 2 * TxAntNum) : 0.0;
         double fer = (progress > 0) ? static_cast<double>(ef) / progress : 0.0;
+        double avg_k = average_k(global_kept_paths.load(), global_searches.load());
 
-        results.push_back({snr, ber, ser, fer, progress});
+        results.push_back({snr, ber, ser, fer, progress, avg_k, global_nodes.hist});
 
         // 清除进度行
         const size_t prev_len = last_progress_len.load();
@@ -157,49 +230,171 @@ std::vector<SnrResult> run_sweep(
                   << "  EF=" << ef
                   << "  BER=" << std::scientific << std::setprecision(4) << ber
                   << "  SER=" << ser
-                  << "  FER=" << fer
-                  << "  " << std::fixed << std::setprecision(2) << elapsed << "s\n";
+                  << "  FER=" << fer;
+        if (avg_k > 0)
+            std::cout << "  avgK=" << std::fixed << std::setprecision(2) << avg_k;
+        print_nodes(global_nodes.hist);
+        std::cout << "  " << std::fixed << std::setprecision(2) << elapsed << "s\n";
+    }
+    return results;
+}
+
+// ===================== 多 SNR 单遍扫描 =====================
+// 每个生成的样本在全部 SNR 点上评估一次：信道、符号和单位噪声只生成一次，
+// 检测器与 SNR 无关的预处理（如 QR）也只做一次，各 SNR 点的曲线因此是相关的、方差更低
+std::vector<SnrResult> run_multi_snr_sweep(
+    const std::string& algo_name,
+    const AlgorithmEntry::MultiWorkerFactory& factory,
+    int snr_start, int snr_end, int snr_step,
+    long long max_sample, long long err_frame_threshold,
+    unsigned int seed)
+{
+    std::vector<int> snrs;
+    for (int snr = snr_start; snr <= snr_end; snr += snr_step)
+        snrs.push_back(snr);
+
+    MultiSnrCounters  counters(snrs.size());
+    std::atomic<bool> should_stop(false);
+
+    const unsigned int num_threads = std::thread::hardware_concurrency();
+
+    auto worker = factory(snrs, counters, should_stop, max_sample, err_frame_threshold);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; ++t)
+        threads.emplace_back(worker, seed + t);
+
+    // 显示线程：只显示仍在评估的 SNR 点数与最高 SNR 点的进度
+    size_t last_progress_len = 0;
+    std::thread display_thread([&]() {
+        while (!should_stop.load(std::memory_order_relaxed)) {
+            size_t active = 0;
+            for (size_t i = 0; i < snrs.size(); ++i)
+                active += counters.active(i, max_sample, err_frame_threshold);
+
+            const size_t last = snrs.size() - 1;
+            std::ostringstream oss;
+            oss << "[" << algo_name << "] active SNR " << active << "/" << snrs.size()
+                << " | SNR " << snrs[last] << "dB N=" << counters.progress[last].load(std::memory_order_relaxed)
+                << " EF=" << counters.err_frames[last].load(std::memory_order_relaxed) << "/" << err_frame_threshold;
+
+            std::string line = oss.str();
+            std::cout << '\r' << line;
+            if (last_progress_len > line.size())
+                std::cout << std::string(last_progress_len - line.size(), ' ');
+            std::cout << '\r';
+            last_progress_len = line.size();
+            std::cout.flush();
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    });
+
+    for (auto& t : threads) t.join();
+    should_stop.store(true);
+    display_thread.join();
+
+    if (last_progress_len > 0)
+        std::cout << std::string(last_progress_len, ' ') << '\r';
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(end - start).count();
+
+    std::vector<SnrResult> results;
+    for (size_t i = 0; i < snrs.size(); ++i) {
+        const long long progress = counters.progress[i].load();
+        const long long ef = counters.err_frames[i].load();
+
+        double ber = rate(counters.err_bits[i].load(), progress, TxAntNum * QAM::bitLength);
+        double ser = rate(counters.err_symbols[i].load(), progress, 2 * TxAntNum);
+        double fer = rate(ef, progress, 1);
+        double avg_k = average_k(counters.kept_paths[i].load(), counters.searches[i].load());
+
+        results.push_back({snrs[i], ber, ser, fer, progress, avg_k, counters.nodes[i].hist});
+
+        std::cout << "[" << algo_name << "] SNR " << snrs[i] << "dB  N=" << progress
+                  << "  EF=" << ef
+                  << "  BER=" << std::scientific << std::setprecision(4) << ber
+                  << "  SER=" << ser
+                  << "  FER=" << fer;
+        if (avg_k > 0)
+            std::cout << "  avgK=" << std::fixed << std::setprecision(2) << avg_k;
+        print_nodes(counters.nodes[i].hist);
+        std::cout << "\n";
     }
+    std::cout << "[" << algo_name << "] single pass over " << snrs.size() << " SNR points  "
+              << std::fixed << std::setprecision(2) << elapsed << "s\n";
+
     return results;
 }
 
 // ===================== Worker 工厂模板 =====================
-// 仅需提供「每帧运行检测并返回估计符号」的 lambda
-// RunBody 签名: (Det& det) -> result_vector
+// 任意满足 Kito::Detector 的检测器类型都可以直接注册，热路径上没有类型擦除
+// 逐 SNR 模式按批生成帧并调用 Kito::runBatch；检测器若提供 runBatch 专门实现则自动使用
+
+static constexpr size_t BATCH_SIZE = 16;
+
+// 提供 averageK（K-Best）或 nodeStats（球形译码）的检测器：把累计的搜索统计转入 local 并清零
+template <typename D>
+void collect_stats(D& detector, ThreadResult& local)
+{
+    if constexpr (requires { detector.averageK(); }) {
+        local.searches   += static_cast<long long>(detector.searches);
+        local.kept_paths += static_cast<long long>(detector.keptPaths);
+        detector.resetStats();
+    }
+    if constexpr (requires { detector.nodeStats; }) {
+        local.nodes.merge(detector.nodeStats);
+        detector.resetStats();
+    }
+}
 
-template <typename RunBody>
-AlgorithmEntry::WorkerFactory make_factory(RunBody body)
+template <typename D>
+requires Kito::Detector<D, Det>
+AlgorithmEntry::WorkerFactory make_factory()
 {
-    return [body](int snr,
-                  std::atomic<long long>& global_progress,
-                  std::atomic<long long>& global_err_frames,
-                  std::atomic<long long>& global_err_bits,
-                  std::atomic<long long>& global_err_symbols,
-                  std::atomic<bool>&      should_stop,
-                  long long max_sample,
-                  long long err_frame_threshold)
+    return [](int snr,
+              std::atomic<long long>& global_progress,
+              std::atomic<long long>& global_err_frames,
+              std::atomic<long long>& global_err_bits,
+              std::atomic<long long>& global_err_symbols,
+              std::atomic<long long>& global_searches,
+              std::atomic<long long>& global_kept_paths,
+              SharedNodeStats&        global_nodes,
+              std::atomic<bool>&      should_stop,
+              long long max_sample,
+              long long err_frame_threshold)
     {
         return [=, &global_progress, &global_err_frames, &global_err_bits,
-                &global_err_symbols, &should_stop](unsigned int thread_seed)
+                &global_err_symbols, &global_searches, &global_kept_paths,
+                &global_nodes, &should_stop](unsigned int thread_seed)
         {
             constexpr int update_interval = 10;
             Kito::set_random_seed(thread_seed);
-            Det det;
-            det.setSNR(snr);
+            D detector;
+            std::vector<Det> frames(BATCH_SIZE);
+            std::vector<Det::X_type> est(BATCH_SIZE);
+            for (auto& det : frames)
+                det.setSNR(snr);
 
             ThreadResult local;
             int local_count = 0;
 
             while (!should_stop.load(std::memory_order_relaxed) &&
                    global_progress.load(std::memory_order_relaxed) < max_sample) {
-                det.generate();
-                auto est = body(det);
-                auto [ser_cnt, ber_cnt, fer_cnt] = det.template judge<SER, BER, FER>(est);
-
-                local.err_frames  += fer_cnt;
-                local.err_bits    += ber_cnt;
-                local.err_symbols += ser_cnt;
-                local.processed++;
+                for (auto& det : frames)
+                    det.generate();
+                Kito::runBatch(detector, std::span(frames), std::span(est));
+                collect_stats(detector, local);
+
+                for (size_t f = 0; f < BATCH_SIZE; ++f) {
+                    auto [ser_cnt, ber_cnt, fer_cnt] = frames[f].template judge<SER, BER, FER>(est[f]);
+                    local.err_frames  += fer_cnt;
+                    local.err_bits    += ber_cnt;
+                    local.err_symbols += ser_cnt;
+                    local.processed++;
+                }
                 local_count++;
 
                 if (local_count % update_interval == 0) {
@@ -208,6 +403,9 @@ AlgorithmEntry::WorkerFactory make_factory(RunBody body)
                                      + local.err_frames;
                     global_err_bits.fetch_add(local.err_bits, std::memory_order_relaxed);
                     global_err_symbols.fetch_add(local.err_symbols, std::memory_order_relaxed);
+                    global_searches.fetch_add(local.searches, std::memory_order_relaxed);
+                    global_kept_paths.fetch_add(local.kept_paths, std::memory_order_relaxed);
+                    global_nodes.merge(local.nodes);
                     local = ThreadResult();
                     local_count = 0;
 
@@ -222,10 +420,103 @@ AlgorithmEntry::WorkerFactory make_factory(RunBody body)
             global_err_frames.fetch_add(local.err_frames, std::memory_order_relaxed);
             global_err_bits.fetch_add(local.err_bits, std::memory_order_relaxed);
             global_err_symbols.fetch_add(local.err_symbols, std::memory_order_relaxed);
+            global_searches.fetch_add(local.searches, std::memory_order_relaxed);
+            global_kept_paths.fetch_add(local.kept_paths, std::memory_order_relaxed);
+            global_nodes.merge(local.nodes);
+        };
+    };
+}
+
+// 逐帧检测；same_channel 为 true 时 det.H 与上一次调用相同，
+// 提供 runPrepared 的检测器可以复用与 SNR 无关的预处理
+template <typename D>
+Det::X_type detect(D& detector, const Det& det, bool same_channel)
+{
+    if constexpr (requires { detector.runPrepared(det); }) {
+        if (same_channel)
+            return detector.runPrepared(det);
+    }
+    return detector.run(det);
+}
+
+template <typename D>
+requires Kito::Detector<D, Det>
+AlgorithmEntry::MultiWorkerFactory make_multi_factory()
+{
+    return [](const std::vector<int>& snrs,
+              MultiSnrCounters&       counters,
+              std::atomic<bool>&      should_stop,
+              long long max_sample,
+              long long err_frame_threshold)
+    {
+        return [=, &counters, &should_stop](unsigned int thread_seed)
+        {
+            constexpr int update_interval = 10;
+            Kito::set_random_seed(thread_seed);
+            D detector;
+            Det det;
+
+            const size_t n = snrs.size();
+            std::vector<ThreadResult> local(n);
+            std::vector<char> active(n, 1);
+            int local_count = 0;
+
+            auto flush = [&]() {
+                for (size_t i = 0; i < n; ++i) {
+                    counters.progress[i].fetch_add(local[i].processed, std::memory_order_relaxed);
+                    counters.err_frames[i].fetch_add(local[i].err_frames, std::memory_order_relaxed);
+                    counters.err_bits[i].fetch_add(local[i].err_bits, std::memory_order_relaxed);
+                    counters.err_symbols[i].fetch_add(local[i].err_symbols, std::memory_order_relaxed);
+                    counters.searches[i].fetch_add(local[i].searches, std::memory_order_relaxed);
+                    counters.kept_paths[i].fetch_add(local[i].kept_paths, std::memory_order_relaxed);
+                    counters.nodes[i].merge(local[i].nodes);
+                    local[i] = ThreadResult();
+                }
+            };
+
+            while (!should_stop.load(std::memory_order_relaxed)) {
+                det.generate();
+
+                bool same_channel = false;
+                for (size_t i = 0; i < n; ++i) {
+                    if (!active[i]) continue;
+
+                    det.applySNR(snrs[i]);
+                    auto est = detect(detector, det, same_channel);
+                    same_channel = true;
+                    collect_stats(detector, local[i]);
+
+                    auto [ser_cnt, ber_cnt, fer_cnt] = det.template judge<SER, BER, FER>(est);
+                    local[i].err_frames  += fer_cnt;
+                    local[i].err_bits    += ber_cnt;
+                    local[i].err_symbols += ser_cnt;
+                    local[i].processed++;
+                }
+
+                if (++local_count % update_interval == 0) {
+                    flush();
+                    bool any_active = false;
+                    for (size_t i = 0; i < n; ++i) {
+                        active[i] = counters.active(i, max_sample, err_frame_threshold);
+                        any_active |= static_cast<bool>(active[i]);
+                    }
+                    if (!any_active) {
+                        should_stop.store(true, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+            flush();
         };
     };
 }
 
+template <typename D>
+AlgorithmEntry make_entry(std::string name)
+{
+    return {std::move(name), make_factory<D>(), make_multi_factory<D>()};
+}
+
 // ===================== 打印汇总表 =====================
 void print_summary(const std::string& name, const std::vector<SnrResult>& res)
 {
@@ -243,6 +534,24 @@ void print_summary(const std::string& name, const std::vector<SnrResult>& res)
     for (size_t i = 0; i < res.size(); ++i)
         std::cout << std::scientific << std::setprecision(6) << res[i].fer << (i + 1 < res.size() ? ", " : "");
     std::cout << "]\n";
+    if (std::any_of(res.begin(), res.end(), [](const SnrResult& r) { return r.avg_k > 0; })) {
+        std::cout << "AvgK: [";
+        for (size_t i = 0; i < res.size(); ++i)
+            std::cout << std::fixed << std::setprecision(2) << res[i].avg_k << (i + 1 < res.size() ? ", " : "");
+        std::cout << "]\n";
+    }
+    if (std::any_of(res.begin(), res.end(), [](const SnrResult& r) { return r.nodes.frames > 0; })) {
+        std::cout << "NodesMean: [";
+        for (size_t i = 0; i < res.size(); ++i)
+            std::cout << std::fixed << std::setprecision(1) << res[i].nodes.mean() << (i + 1 < res.size() ? ", " : "");
+        std::cout << "]\nNodesP99: [";
+        for (size_t i = 0; i < res.size(); ++i)
+            std::cout << res[i].nodes.quantile(0.99) << (i + 1 < res.size() ? ", " : "");
+        std::cout << "]\nNodesMax: [";
+        for (size_t i = 0; i < res.size(); ++i)
+            std::cout << res[i].nodes.max << (i + 1 < res.size() ? ", " : "");
+        std::cout << "]\n";
+    }
 }
 
 // ===================== main =====================
@@ -254,6 +563,7 @@ int main(int argc, char* argv[])
     int snr_end   = 27;
     int snr_step  = 1;
     unsigned int seed = 114514;
+    bool single_pass = false;   // 1: 每个样本一次评估全部 SNR 点
 
     if (argc > 1) max_sample          = atoll(argv[1]);
     if (argc > 2) err_frame_threshold = atoll(argv[2]);
@@ -261,44 +571,48 @@ int main(int argc, char* argv[])
     if (argc > 4) snr_end             = atoi(argv[4]);
     if (argc > 5) snr_step            = atoi(argv[5]);
     if (argc > 6) seed                = atoi(argv[6]);
+    if (argc > 7) single_pass         = atoi(argv[7]) != 0;
 
     std::cout << "=== Detection Benchmark ===\n"
               << "  MIMO: " << TxAntNum << "x" << RxAntNum << "\n"
               << "  QAM:  " << (1 << QAM::bitLength) << "-QAM\n"
               << "  SNR:  " << snr_start << " ~ " << snr_end << " dB (step " << snr_step << ")\n"
               << "  Threads: " << std::thread::hardware_concurrency() << "\n"
+              << "  Mode: " << (single_pass ? "single pass over all SNR points" : "per SNR point") << "\n"
               << "===========================\n\n";
 
     // ---- 注册所有算法 ----
     std::vector<AlgorithmEntry> algorithms;
 
     // 1. MMSE
-    algorithms.push_back({"MMSE", make_factory([](Det& det) {
-        auto mmse = Kito::MMSE<QAM, typename Det::PrecType, TxAntNum, RxAntNum>(
-            det.H, det.RxSymbols, static_cast<typename Det::PrecType>(det.Nv));
-        return mmse.normalized_symbols();
-    })});
+    algorithms.push_back(make_entry<Kito::MMSE<QAM, typename Det::PrecType, TxAntNum, RxAntNum>>("MMSE"));
 
     // 2. K-Best
-    algorithms.push_back({"KBest-" + std::to_string(K_BEST_K), make_factory([](Det& det) {
-        thread_local auto kbest = Kito::KBest<Det, K_BEST_K>();
-        return kbest.run(det);
-    })});
+    algorithms.push_back(make_entry<Kito::KBest<Det, K_BEST_K>>("KBest-" + std::to_string(K_BEST_K)));
+
+    // 3. 自适应 K-Best：K_BEST_K 为上限，avgK 为每层平均保留的路径数
+    algorithms.push_back(make_entry<Kito::AdaptiveKBest<Det, K_BEST_K>>("AdaptiveKBest-" + std::to_string(K_BEST_K)));
+
+    // 4. EP
+    algorithms.push_back(make_entry<Kito::EP<Det, EP_ITER>>("EP-" + std::to_string(EP_ITER)));
 
-    // 3. EP
-    algorithms.push_back({"EP-" + std::to_string(EP_ITER), make_factory([](Det& det) {
-        thread_local auto ep = Kito::EP<Det, EP_ITER>();
-        return ep.run(det);
-    })});
+    // 5. 球形译码（ML）：排序与初始半径只用接收端可得的信息，输出每帧访问节点数的均值 / p99 / 最大值。
+    //    复杂度随天线数指数增长，只在小规模配置下注册
+    if constexpr (TxAntNum <= 8)
+        algorithms.push_back(make_entry<Kito::SphereDecoder<Det>>("SphereDecoder"));
 
     // ---- 逐算法运行 ----
     std::vector<std::pair<std::string, std::vector<SnrResult>>> all_results;
 
     for (const auto& algo : algorithms) {
         std::cout << "\n>>>>> Running: " << algo.name << " <<<<<\n";
-        auto res = run_sweep(algo.name, algo.factory,
-                             snr_start, snr_end, snr_step,
-                             max_sample, err_frame_threshold, seed);
+        auto res = single_pass
+                       ? run_multi_snr_sweep(algo.name, algo.multi_factory,
+                                             snr_start, snr_end, snr_step,
+                                             max_sample, err_frame_threshold, seed)
+                       : run_sweep(algo.name, algo.factory,
+                                   snr_start, snr_end, snr_step,
+                                   max_sample, err_frame_threshold, seed);
         all_results.emplace_back(algo.name, std::move(res));
     }
 
@@ -0,0 +1,56 @@
+#include "kernels.hpp"
+#include <chrono>
+
+using namespace Kito;
+
+namespace {
+
+using Det = Detection<Rx<8>, Tx<8>, Mod<QAM16<float>>>;
+
+template <typename Fn>
+double time_us(size_t n, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+        fn(i);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count() / static_cast<double>(n);
+}
+
+} // namespace
+
+// 本翻译单元内的 Eigen 与 Kito 代码全部按当前变体的 -march 生成
+KernelTimings KITO_ISA_FN(runKernels)(size_t frames) {
+    std::vector<Det> dets(frames);
+    for (auto& d : dets) {
+        d.setSNR(14);
+        d.generate();
+    }
+
+    MMSE<QAM16<float>, float, 8, 8> mmse;
+    EP<Det> ep;
+    KBest<Det, 16> kbest;
+    SphereDecoder<Det> sd;
+
+    // 防止结果被优化掉
+    float sink = 0;
+
+    KernelTimings t{};
+    t.mmse_us = time_us(frames, [&](size_t i) { sink += mmse.run(dets[i])(0); });
+    t.ep_us = time_us(frames, [&](size_t i) { sink += ep.run(dets[i])(0); });
+    t.kbest_us = time_us(frames, [&](size_t i) { sink += kbest.run(dets[i])(0); });
+    t.sd_us = time_us(frames, [&](size_t i) { sink += sd.run(dets[i])(0); });
+
+    nrLDPC<1024, 0.5> ldpc;
+    std::vector<double> llr(2048);
+    const size_t codewords = std::max<size_t>(frames / 100, 1);
+    t.ldpc_us = time_us(codewords, [&](size_t) {
+        for (auto& l : llr)
+            l = 2.0 + normal_distribution<0, 1>();
+        ldpc.rateRecover(llr);
+        sink += ldpc.decode(5)[0];
+    });
+
+    if (sink == 12345.f)
+        std::cout << "";
+    return t;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "Kitokarosu.hpp"
+
+// 每个内核的单次调用耗时（微秒）
+struct KernelTimings {
+    double mmse_us;
+    double ep_us;
+    double kbest_us;
+    double sd_us;
+    double ldpc_us;
+};
+
+using KernelFn = KernelTimings (*)(size_t frames);
+
+// kernels.cpp 以不同的 -march 各编译一次，分别导出以下入口
+KITO_ISA_EXPORT KernelTimings runKernels_generic(size_t frames);
+KITO_ISA_EXPORT KernelTimings runKernels_avx2(size_t frames);
+KITO_ISA_EXPORT KernelTimings runKernels_avx512(size_t frames);
@@ -0,0 +1,29 @@
+#include "kernels.hpp"
+#include <iomanip>
+
+using namespace Kito;
+
+// 同一二进制内含 generic / AVX2 / AVX-512 三个内核变体，启动时按 CPU 特性选择。
+// 设置 KITO_FORCE_ISA=generic|avx2 可强制使用较低档位做对比。
+int main() {
+    const IsaDispatch<KernelFn> kernels{runKernels_generic, runKernels_avx2, runKernels_avx512};
+    const Isa isa = detectIsa();
+    std::cout << "Detected ISA: " << isaName(isa) << std::endl;
+
+    constexpr size_t frames = 20000;
+    std::cout << std::left << std::setw(10) << "Variant" << std::right << std::setw(12) << "MMSE (us)"
+              << std::setw(12) << "EP (us)" << std::setw(12) << "KBest (us)" << std::setw(12) << "SD (us)"
+              << std::setw(12) << "LDPC (us)" << std::endl;
+
+    // 依次运行当前 CPU 可执行的全部变体，最后一行即 select() 的选择
+    for (Isa v : {Isa::Generic, Isa::AVX2, Isa::AVX512}) {
+        if (v > isa)
+            break;
+        const KernelTimings t = kernels.select(v)(frames);
+        std::cout << std::left << std::setw(10) << isaName(v) << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << t.mmse_us << std::setw(12) << t.ep_us << std::setw(12) << t.kbest_us
+                  << std::setw(12) << t.sd_us << std::setw(12) << t.ldpc_us << std::endl;
+    }
+
+    return 0;
+}
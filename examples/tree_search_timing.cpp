@@ -0,0 +1,178 @@
+#include "Kitokarosu.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace Kito;
+
+// 树搜索检测器的单帧耗时对比：所有变体处理同一批帧，结果一致时只比较时间。
+// 用法：tree_search_timing [每个配置的帧数]
+
+template <typename Fn>
+double time_us(size_t n, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+        fn(i);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count() / static_cast<double>(n);
+}
+
+template <typename Det>
+std::vector<Det> make_frames(size_t frames, double snr) {
+    std::vector<Det> dets(frames);
+    for (auto& d : dets) {
+        d.setSNR(snr);
+        d.generate();
+    }
+    return dets;
+}
+
+// K-Best 展开内核：逐路径的 K 路归并 vs 按路径并行（K 个 lane）的 SIMD 展开。
+// 信道 QR 在计时外完成，只计 Q^T y 与树搜索
+template <size_t Tx_, size_t Rx_, size_t K, typename QAM>
+void kbest_expansion(size_t frames, double snr) {
+    using Det = Detection<Rx<Rx_>, Tx<Tx_>, Mod<QAM>>;
+    const auto dets = make_frames<Det>(frames, snr);
+
+    auto kbest = std::make_unique<KBest<Det, K>>();
+    std::vector<typename Det::X_type> out(frames);
+    double us[2];
+    for (int lane = 0; lane < 2; ++lane) {
+        kbest->laneExpansion = lane;
+        double total = 0;
+        for (size_t i = 0; i < frames; ++i) {
+            kbest->prepareChannel(dets[i]);
+            total += time_us(1, [&](size_t) { out[i] = kbest->runPrepared(dets[i]); });
+        }
+        us[lane] = total / static_cast<double>(frames);
+    }
+
+    // 两条路径的结果应完全一致
+    size_t mismatch = 0;
+    for (size_t i = 0; i < frames; ++i) {
+        kbest->laneExpansion = false;
+        mismatch += kbest->run(dets[i]) != out[i];
+    }
+
+    std::cout << std::left << std::setw(10) << (std::to_string(Tx_) + "x" + std::to_string(Rx_))
+              << std::right << std::setw(6) << K << std::fixed << std::setprecision(2)
+              << std::setw(14) << us[0] << std::setw(14) << us[1]
+              << std::setw(10) << us[0] / us[1] << "x" << std::setw(10) << mismatch << std::endl;
+}
+
+// 信道预处理随 Rx/Tx 的变化：显式构造 Q 再取前 2Tx 列 vs ThinQR 直接施加反射 vs SortedQR（SQRD）。
+// 每种方式都包含一次分解与一次 Q^T y，diff 为前两者 z 的最大偏差
+template <size_t Tx_, size_t Rx_>
+void qr_preprocessing(size_t frames) {
+    using Det = Detection<Rx<Rx_>, Tx<Tx_>, Mod<QAM16<float>>>;
+    constexpr size_t N = 2 * Tx_;
+    const auto dets = make_frames<Det>(frames, 10);
+
+    auto hqr = std::make_unique<Eigen::HouseholderQR<typename Det::H_type>>();
+    auto thin = std::make_unique<ThinQR<float, Rx_, Tx_>>();
+    auto sqr = std::make_unique<SortedQR<float, Rx_, Tx_>>();
+    std::vector<Eigen::Vector<float, N>> zf(frames), zt(frames), zs(frames);
+
+    const double full_us = time_us(frames, [&](size_t i) {
+        hqr->compute(dets[i].H);
+        const Eigen::MatrixXf Q = hqr->householderQ();
+        zf[i].noalias() = Q.leftCols(N).transpose() * dets[i].RxSymbols;
+    });
+    const double thin_us = time_us(frames, [&](size_t i) {
+        thin->compute(dets[i].H);
+        zt[i] = thin->rotate(dets[i].RxSymbols);
+    });
+    const double sqrd_us = time_us(frames, [&](size_t i) {
+        sqr->compute(dets[i].H);
+        zs[i] = sqr->rotate(dets[i].RxSymbols);
+    });
+
+    float diff = 0;
+    for (size_t i = 0; i < frames; ++i)
+        diff = std::max(diff, (zf[i] - zt[i]).cwiseAbs().maxCoeff());
+
+    std::cout << std::left << std::setw(10) << (std::to_string(Tx_) + "x" + std::to_string(Rx_))
+              << std::right << std::setw(6) << Rx_ / Tx_ << std::fixed << std::setprecision(2)
+              << std::setw(12) << full_us << std::setw(12) << thin_us << std::setw(12) << sqrd_us
+              << std::setw(10) << full_us / thin_us << "x" << std::scientific << std::setprecision(1)
+              << std::setw(10) << diff << std::endl;
+}
+
+// 球形译码的单帧时延分布：单线程 vs 帧内并行（全部硬件线程），关注 p99 与最坏帧
+template <size_t Tx_, size_t Rx_, typename QAM>
+void sphere_latency(size_t frames, double snr, unsigned threads) {
+    using Det = Detection<Rx<Rx_>, Tx<Tx_>, Mod<QAM>>;
+    const auto dets = make_frames<Det>(frames, snr);
+
+    auto sd = std::make_unique<SphereDecoder<Det>>();
+    std::vector<typename Det::X_type> out(frames);
+    size_t mismatch = 0;
+    for (unsigned t : {1u, threads}) {
+        sd->threads = t;
+        std::vector<double> us(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            sd->prepareChannel(dets[i]);
+            us[i] = time_us(1, [&](size_t) {
+                const auto x = sd->runPrepared(dets[i]);
+                if (t == 1)
+                    out[i] = x;
+                else
+                    mismatch += x != out[i];
+            });
+        }
+        std::sort(us.begin(), us.end());
+        double mean = 0;
+        for (double v : us)
+            mean += v / static_cast<double>(frames);
+
+        std::cout << std::left << std::setw(10) << (std::to_string(Tx_) + "x" + std::to_string(Rx_))
+                  << std::right << std::setw(8) << t << std::fixed << std::setprecision(2)
+                  << std::setw(12) << mean << std::setw(12) << us[frames * 99 / 100] << std::setw(12) << us.back()
+                  << std::setw(14) << sd->nodeStats.mean() << std::setw(10) << mismatch << std::endl;
+        sd->resetStats();
+        if (threads == 1)
+            break;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t frames = argc > 1 ? static_cast<size_t>(atoll(argv[1])) : 2000;
+
+    std::cout << "--- KBest expansion (64-QAM, us per search) ---" << std::endl;
+    std::cout << std::left << std::setw(10) << "MIMO" << std::right << std::setw(6) << "K"
+              << std::setw(14) << "merge" << std::setw(14) << "lanes" << std::setw(11) << "speedup"
+              << std::setw(10) << "mismatch" << std::endl;
+    kbest_expansion<16, 16, 16, QAM64<float>>(frames, 20);
+    kbest_expansion<16, 16, 32, QAM64<float>>(frames, 20);
+    kbest_expansion<32, 32, 16, QAM64<float>>(frames, 24);
+    kbest_expansion<32, 32, 32, QAM64<float>>(frames, 24);
+
+    // 分解的开销随 Rx 线性增长，显式构造 Q 随 Rx^2 增长，因此只用 1/4 的帧数
+    std::cout << "\n--- QR preprocessing vs Rx/Tx (us per frame, factorization + Q^T y) ---" << std::endl;
+    std::cout << std::left << std::setw(10) << "MIMO" << std::right << std::setw(6) << "Rx/Tx"
+              << std::setw(12) << "full Q" << std::setw(12) << "thin" << std::setw(12) << "SQRD"
+              << std::setw(11) << "speedup" << std::setw(10) << "diff" << std::endl;
+    const size_t qr_frames = std::max<size_t>(frames / 4, 1);
+    qr_preprocessing<16, 16>(qr_frames);
+    qr_preprocessing<16, 32>(qr_frames);
+    qr_preprocessing<16, 64>(qr_frames);
+    qr_preprocessing<16, 128>(qr_frames);
+    qr_preprocessing<32, 32>(qr_frames);
+    qr_preprocessing<32, 64>(qr_frames);
+    qr_preprocessing<32, 128>(qr_frames);
+    qr_preprocessing<32, 256>(qr_frames);
+
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\n--- SphereDecoder latency (16-QAM, us per frame) ---" << std::endl;
+    std::cout << std::left << std::setw(10) << "MIMO" << std::right << std::setw(8) << "threads"
+              << std::setw(12) << "mean" << std::setw(12) << "p99" << std::setw(12) << "max"
+              << std::setw(14) << "nodes" << std::setw(10) << "mismatch" << std::endl;
+    sphere_latency<12, 12, QAM16<float>>(frames / 4 + 1, 12, threads);
+    sphere_latency<16, 16, QAM16<float>>(frames / 4 + 1, 12, threads);
+
+    return 0;
+}
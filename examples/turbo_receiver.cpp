@@ -0,0 +1,119 @@
+#include "Kitokarosu.hpp"
+#include <iostream>
+#include <array>
+#include <tuple>
+#include <iomanip>
+#include <cmath>
+
+using namespace Kito;
+
+// 比较一次性 MMSE + LDPC 与 turbo 检测-译码迭代：
+// 所有接收机处理同一批码字与信道，同时统计 FER 与复杂度（检测次数、累计 LDPC 迭代次数）。
+struct SimConfig {
+    static constexpr size_t TxAntNum = 4;
+    static constexpr size_t RxAntNum = 4;
+    using QAM = QAM16<float>;
+
+    static constexpr double snr_start_db = 4.0;
+    static constexpr double snr_end_db = 12.0;
+    static constexpr double snr_step_db = 2.0;
+
+    static constexpr long long max_frame_errors = 100;
+    static constexpr long long max_total_frames = 5000;
+
+    static constexpr size_t S = 10;
+    static constexpr double ldpc_rate = 0.5;
+
+    static constexpr size_t M = S * TxAntNum * QAM::bitLength;
+    static constexpr size_t K = static_cast<size_t>(ldpc_rate * M);
+};
+
+using Det = Detection<Rx<SimConfig::RxAntNum>, Tx<SimConfig::TxAntNum>, Mod<SimConfig::QAM>>;
+using LDPC = nrLDPC<SimConfig::K, SimConfig::ldpc_rate>;
+using PIC = MMSEPIC<SimConfig::QAM, float, SimConfig::TxAntNum, SimConfig::RxAntNum>;
+
+struct Stats {
+    const char* name;
+    long long frame_errors = 0;
+    long long detections = 0;
+    long long ldpc_iters = 0;
+};
+
+template <typename Receiver>
+Receiver make_receiver(unsigned outer, unsigned inner) {
+    Receiver rx;
+    rx.outerIter = outer;
+    rx.innerIter = inner;
+    return rx;
+}
+
+int main() {
+    std::cout << "--- System Parameters ---" << std::endl;
+    std::cout << "  MIMO Config: " << SimConfig::TxAntNum << "x" << SimConfig::RxAntNum << ", 16-QAM" << std::endl;
+    std::cout << "  LDPC Rate:   " << SimConfig::ldpc_rate << ", K = " << SimConfig::K << ", M = " << SimConfig::M << std::endl;
+    std::cout << "-------------------------" << std::endl;
+
+    // 一次性检测 + 译码即 outerIter = 1 的 turbo 接收机
+    auto receivers = std::make_tuple(
+        make_receiver<TurboReceiver<PIC, LDPC>>(1, 10),
+        make_receiver<TurboReceiver<PIC, LDPC>>(1, 30),
+        make_receiver<TurboReceiver<PIC, LDPC>>(4, 5),
+        make_receiver<TurboReceiver<EP<Det, 4>, LDPC>>(3, 5));
+    const std::array<const char*, 4> names = {"MMSE + LDPC(10)", "MMSE + LDPC(30)", "MMSE-PIC 4 x 5", "EP 3 x 5"};
+
+    const int num_snr_steps = static_cast<int>(std::round((SimConfig::snr_end_db - SimConfig::snr_start_db) / SimConfig::snr_step_db));
+
+    std::cout << std::left << std::setw(10) << "SNR (dB)" << std::setw(18) << "Receiver" << std::right
+              << std::setw(10) << "Frames" << std::setw(12) << "FER" << std::setw(12) << "Det/frame"
+              << std::setw(14) << "LDPC it/frame" << std::endl;
+
+    for (int i = 0; i <= num_snr_steps; ++i) {
+        const double snr_db = SimConfig::snr_start_db + i * SimConfig::snr_step_db;
+
+        std::array<Det, SimConfig::S> frames;
+        for (auto& f : frames)
+            f.setSNR(snr_db);
+
+        std::array<Stats, 4> stats;
+        for (size_t r = 0; r < stats.size(); ++r)
+            stats[r].name = names[r];
+
+        long long frame_count = 0;
+        // 以一次性 MMSE 基线的错误数作为停止条件
+        while (stats[0].frame_errors < SimConfig::max_frame_errors && frame_count < SimConfig::max_total_frames) {
+            LDPC ldpc;
+            ldpc.encode();
+            auto rm = std::array<bool, SimConfig::M>{};
+            ldpc.rateMatch(rm);
+
+            for (size_t s = 0; s < SimConfig::S; ++s)
+                frames[s].generate(rm.begin() + s * SimConfig::TxAntNum * SimConfig::QAM::bitLength);
+
+            size_t r = 0;
+            std::apply([&](auto&... rx) {
+                ([&] {
+                    const auto& res = rx.run(ldpc, std::span<const Det>(frames));
+                    stats[r].frame_errors += !std::equal(ldpc.msg.begin(), ldpc.msg.end(), res.begin());
+                    stats[r].detections += rx.outerUsed * SimConfig::S;
+                    stats[r].ldpc_iters += rx.innerUsed;
+                    ++r;
+                }(), ...);
+            }, receivers);
+
+            frame_count++;
+        }
+
+        for (const auto& st : stats) {
+            std::cout << std::left << std::setw(10) << std::fixed << std::setprecision(1) << snr_db
+                      << std::setw(18) << st.name << std::right
+                      << std::setw(10) << frame_count
+                      << std::setw(12) << std::scientific << std::setprecision(3)
+                      << static_cast<double>(st.frame_errors) / frame_count
+                      << std::setw(12) << std::fixed << std::setprecision(2)
+                      << static_cast<double>(st.detections) / frame_count
+                      << std::setw(14) << static_cast<double>(st.ldpc_iters) / frame_count << std::endl;
+        }
+    }
+
+    return 0;
+}